@@ -1,6 +1,6 @@
 QT       += core gui
 
-QT       += webenginewidgets webchannel
+QT       += webenginewidgets webchannel concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -12,12 +12,29 @@ CONFIG += c++17
 
 SOURCES += \
     ais_anal.cpp \
+    aisstringpool.cpp \
+    deadreckoning.cpp \
     main.cpp \
-    mapwindow.cpp
+    mapwindow.cpp \
+    messagescheduler.cpp \
+    positionstore.cpp \
+    shipcluster.cpp \
+    shipshm.cpp \
+    shipsnapshot.cpp
 
 HEADERS += \
     ais_anal.h \
-    mapwindow.h
+    aisstringpool.h \
+    deadreckoning.h \
+    mapwindow.h \
+    messagescheduler.h \
+    positionstore.h \
+    shipcluster.h \
+    shipshm.h \
+    shipsnapshot.h
+
+# shm_open 在较旧的glibc中位于librt
+unix:!macx: LIBS += -lrt
 
 FORMS += \
     mapwindow.ui
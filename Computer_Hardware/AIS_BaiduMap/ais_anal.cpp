@@ -1,4 +1,5 @@
 #include "ais_anal.h"
+#include "aisstringpool.h"
 #include <QFile>
 #include <QTextStream>
 #include <QDebug>
@@ -55,15 +56,14 @@ int AisAnal::binToInt(const QString& bin, int start, int length, bool signedVal)
 }
 
 QString AisAnal::extractAscii6(const QString& bin, int start, int length) {
-    QString result;
-    for (int i = 0; i < length; i += 6) {
-        QString bits = bin.mid(start + i, 6);
-        bool ok;
-        int val = bits.toInt(&ok, 2);
-        if (!ok) continue;
-        result += (val < 32) ? QChar(val + 64) : QChar(val);
-    }
-    return result.trimmed();
+    // 经驻留池查找，重复出现的船名/呼号/目的地只做一次哈希查找
+    AisStringPool& pool = AisStringPool::instance();
+    return pool.text(pool.internAscii6(bin, start, length));
+}
+
+QString AisAnal::internNumber(int value) {
+    AisStringPool& pool = AisStringPool::instance();
+    return pool.text(pool.internNumber(value));
 }
 
 AisMessage AisAnal::parseLine(const QString& line, const QDateTime& timestamp) {
@@ -107,7 +107,7 @@ AisMessage AisAnal::parsePayload(const QString& payload, int fillBits, const QDa
     }
 
     msg.type = binToInt(bits, 0, 6);
-    msg.mmsi = QString::number(binToInt(bits, 8, 30));
+    msg.mmsi = internNumber(binToInt(bits, 8, 30));
 
     // 解析位置和航向信息
     if (msg.type == 1 || msg.type == 2 || msg.type == 3 || msg.type == 18) {
@@ -124,13 +124,13 @@ AisMessage AisAnal::parsePayload(const QString& payload, int fillBits, const QDa
         msg.fixType = binToInt(bits, 133, 4);
 
         // 设置MMSI
-        msg.mmsi = QString::number(binToInt(bits, 8, 30));
+        msg.mmsi = internNumber(binToInt(bits, 8, 30));
     }else if(msg.type == 5){
         // 处理船舶静态和航程相关数据
-        msg.imo = QString::number(binToInt(bits, 40, 30));
+        msg.imo = internNumber(binToInt(bits, 40, 30));
         msg.callsign = extractAscii6(bits, 70, 42);
         msg.name = extractAscii6(bits, 112, 120);
-        msg.shipType = QString::number(binToInt(bits, 232, 8));
+        msg.shipType = internNumber(binToInt(bits, 232, 8));
         msg.dimensionToBow = binToInt(bits, 240, 9);
         msg.dimensionToStern = binToInt(bits, 249, 9);
         msg.dimensionToPort = binToInt(bits, 258, 6);
@@ -138,7 +138,7 @@ AisMessage AisAnal::parsePayload(const QString& payload, int fillBits, const QDa
         msg.destination = extractAscii6(bits, 302, 120);
 
         // 设置MMSI
-        msg.mmsi = QString::number(binToInt(bits, 8, 30));
+        msg.mmsi = internNumber(binToInt(bits, 8, 30));
     }else if(msg.type == 21){
         // 处理助航设备报告
         msg.aidType = binToInt(bits, 38, 5);
@@ -150,7 +150,7 @@ AisMessage AisAnal::parsePayload(const QString& payload, int fillBits, const QDa
         msg.isVirtual = binToInt(bits, 262, 1) == 1;
 
         // 设置MMSI
-        msg.mmsi = QString::number(binToInt(bits, 8, 30));
+        msg.mmsi = internNumber(binToInt(bits, 8, 30));
     }else {
         msg.error = "未支持的类型：" + QString::number(msg.type);
     }
@@ -38,6 +38,7 @@ struct AisMessage {
     int fixType = 0;
 };
 
+// 文本字段经进程内共享的 AisStringPool 驻留（池内部加锁，可多线程调用）
 class AisAnal {
 public:
     static AisMessage parseLine(const QString& line, const QDateTime& timestamp);
@@ -46,6 +47,7 @@ public:
 private:
     static QString sixBitToBinary(const QString& payload);
     static QString extractAscii6(const QString& bin, int start, int length);
+    static QString internNumber(int value);
     static int binToInt(const QString& bin, int start, int length, bool signedVal = false);
     static bool checkNMEAChecksum(const QString &line);
     static bool isPayloadValid(const QString &payload);
@@ -0,0 +1,93 @@
+#include "aisstringpool.h"
+
+static const int kMaxKeyBits = 128;
+
+AisStringPool& AisStringPool::instance()
+{
+    static AisStringPool pool;
+    return pool;
+}
+
+AisStringPool::AisStringPool()
+{
+    texts.append(QString()); // 句柄0固定为空字符串
+}
+
+QString AisStringPool::decodeAscii6(const QString& bin, int start, int length)
+{
+    QString result;
+    for (int i = 0; i < length; i += 6) {
+        QString bits = bin.mid(start + i, 6);
+        bool ok;
+        int val = bits.toInt(&ok, 2);
+        if (!ok) continue;
+        result += (val < 32) ? QChar(val + 64) : QChar(val);
+    }
+    return result.trimmed();
+}
+
+AisTextHandle AisStringPool::add(const QString& value)
+{
+    if (value.isEmpty()) return 0;
+
+    // 不同填充方式可能解码出相同文本，按文本再合并一次
+    auto it = textIndex.constFind(value);
+    if (it != textIndex.constEnd()) return it.value();
+
+    AisTextHandle handle = static_cast<AisTextHandle>(texts.size());
+    texts.append(value);
+    textIndex.insert(value, handle);
+    return handle;
+}
+
+AisTextHandle AisStringPool::internAscii6(const QString& bin, int start, int length)
+{
+    // 报文被截断时只取实际存在的完整字符；起点已越界时直接返回空串
+    int usable = qMin(length, qMax(0, static_cast<int>(bin.size()) - start));
+    usable -= usable % 6;
+    if (start < 0 || usable <= 0) return 0;
+
+    QMutexLocker locker(&mutex);
+    if (usable > kMaxKeyBits) {
+        return add(decodeAscii6(bin, start, usable));
+    }
+
+    Ascii6Key key;
+    key.bits = usable;
+    const QChar* p = bin.constData() + start;
+    for (int i = 0; i < usable; i++) {
+        quint64 bit = (p[i] == QLatin1Char('1')) ? 1 : 0;
+        if (i < 64) key.hi = (key.hi << 1) | bit;
+        else key.lo = (key.lo << 1) | bit;
+    }
+
+    auto it = ascii6Index.constFind(key);
+    if (it != ascii6Index.constEnd()) return it.value();
+
+    AisTextHandle handle = add(decodeAscii6(bin, start, usable));
+    ascii6Index.insert(key, handle);
+    return handle;
+}
+
+AisTextHandle AisStringPool::internNumber(qint64 value)
+{
+    QMutexLocker locker(&mutex);
+    auto it = numberIndex.constFind(value);
+    if (it != numberIndex.constEnd()) return it.value();
+
+    AisTextHandle handle = add(QString::number(value));
+    numberIndex.insert(value, handle);
+    return handle;
+}
+
+QString AisStringPool::text(AisTextHandle handle) const
+{
+    QMutexLocker locker(&mutex);
+    return handle < static_cast<AisTextHandle>(texts.size()) ? texts[handle] : QString();
+}
+
+int AisStringPool::size() const
+{
+    QMutexLocker locker(&mutex);
+    return texts.size() - 1;
+}
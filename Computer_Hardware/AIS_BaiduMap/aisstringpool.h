@@ -0,0 +1,55 @@
+#ifndef AISSTRINGPOOL_H
+#define AISSTRINGPOOL_H
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+
+// 字符串句柄，0 表示空字符串
+using AisTextHandle = quint32;
+
+// 报文文本字段（船名、呼号、目的地、MMSI等）的驻留池。
+// 同一艘船反复上报的内容几乎不变，驻留后每个不同取值只保存一份，
+// AisMessage 中的 QString 通过隐式共享引用池内的同一份数据。
+// 池为进程内单例，内部加锁，AisAnal 的静态解析函数可在多个线程中同时调用。
+class AisStringPool {
+public:
+    static AisStringPool& instance();
+
+    // 直接用打包后的6位比特做键查找，命中时无需再转换成文本
+    AisTextHandle internAscii6(const QString& bin, int start, int length);
+    // 数值型字段（MMSI、IMO、船舶类型）
+    AisTextHandle internNumber(qint64 value);
+
+    QString text(AisTextHandle handle) const;
+    int size() const;
+
+private:
+    AisStringPool();
+
+    // 最长120位（20个字符），装入两个64位字
+    struct Ascii6Key {
+        quint64 hi = 0;
+        quint64 lo = 0;
+        int bits = 0;
+
+        bool operator==(const Ascii6Key& other) const {
+            return hi == other.hi && lo == other.lo && bits == other.bits;
+        }
+    };
+    friend size_t qHash(const Ascii6Key& key, size_t seed) {
+        return qHashMulti(seed, key.hi, key.lo, key.bits);
+    }
+
+    static QString decodeAscii6(const QString& bin, int start, int length);
+    AisTextHandle add(const QString& value);
+
+    QHash<Ascii6Key, AisTextHandle> ascii6Index;
+    QHash<qint64, AisTextHandle> numberIndex;
+    QHash<QString, AisTextHandle> textIndex;
+    QVector<QString> texts;
+    mutable QMutex mutex;
+};
+
+#endif // AISSTRINGPOOL_H
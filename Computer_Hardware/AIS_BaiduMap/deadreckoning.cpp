@@ -0,0 +1,125 @@
+#include "deadreckoning.h"
+#include "shipcluster.h"
+#include <QDateTime>
+#include <QtMath>
+
+// 超过该时长不再外推，退回最后定位，避免长时间失联的船漂出很远
+static const qint64 kMaxExtrapolateMs = 3 * 60 * 1000;
+// 新定位到达后，用多长时间把推算误差消除
+static const qint64 kCorrectionMs = 2000;
+// 误差超过约1公里时认为推算已不可信，直接跳到新位置
+static const double kMaxCorrectionDeg = 0.01;
+// 航速低于该值视为静止（节）
+static const double kMinMovingSog = 0.2;
+
+static const double kMetersPerDegree = 111320.0;
+static const double kKnotToMetersPerMs = 1852.0 / 3600.0 / 1000.0;
+
+void DeadReckoning::projectTrack(const Track& track, qint64 nowMs, double& latitude, double& longitude)
+{
+    qint64 age = nowMs - track.arrivalMs;
+    if (age >= kMaxExtrapolateMs) {
+        latitude = track.latitude;
+        longitude = track.longitude;
+        return;
+    }
+
+    qint64 dt = qMax<qint64>(0, age);
+    double decay = 1.0 - qBound(0.0, double(dt) / kCorrectionMs, 1.0);
+
+    latitude = track.latitude + track.latPerMs * dt + track.errLat * decay;
+    longitude = track.longitude + track.lngPerMs * dt + track.errLng * decay;
+}
+
+bool DeadReckoning::isMoving(const Track& track, qint64 nowMs)
+{
+    bool hasVelocity = track.latPerMs != 0 || track.lngPerMs != 0;
+    qint64 age = nowMs - track.arrivalMs;
+    bool correcting = age < kCorrectionMs && (track.errLat != 0 || track.errLng != 0);
+    return (hasVelocity && age < kMaxExtrapolateMs) || correcting;
+}
+
+void DeadReckoning::updateFix(const QString& mmsi, double latitude, double longitude,
+                              double sog, double cog)
+{
+    if (!ShipClusterIndex::isValidPosition(latitude, longitude)) {
+        remove(mmsi);
+        return;
+    }
+
+    qint64 arrivalMs = QDateTime::currentMSecsSinceEpoch();
+
+    Track track;
+    track.latitude = latitude;
+    track.longitude = longitude;
+    track.arrivalMs = arrivalMs;
+    track.latPerMs = 0;
+    track.lngPerMs = 0;
+    track.errLat = 0;
+    track.errLng = 0;
+    track.settled = false;
+
+    // 102.3节和360°分别表示航速、航向不可用
+    if (sog >= kMinMovingSog && sog < 102.3 && cog >= 0 && cog < 360) {
+        double metersPerMs = sog * kKnotToMetersPerMs;
+        double course = qDegreesToRadians(cog);
+        track.latPerMs = metersPerMs * qCos(course) / kMetersPerDegree;
+        track.lngPerMs = metersPerMs * qSin(course)
+                         / (kMetersPerDegree * qMax(0.01, qCos(qDegreesToRadians(latitude))));
+    }
+
+    // 从当前显示位置平滑过渡到新定位
+    auto it = tracks.constFind(mmsi);
+    if (it != tracks.constEnd()) {
+        double shownLat, shownLng;
+        projectTrack(*it, arrivalMs, shownLat, shownLng);
+        double errLat = shownLat - latitude;
+        double errLng = shownLng - longitude;
+        if (qAbs(errLat) <= kMaxCorrectionDeg && qAbs(errLng) <= kMaxCorrectionDeg) {
+            track.errLat = errLat;
+            track.errLng = errLng;
+        }
+    }
+
+    tracks.insert(mmsi, track);
+}
+
+void DeadReckoning::remove(const QString& mmsi)
+{
+    tracks.remove(mmsi);
+}
+
+void DeadReckoning::clear()
+{
+    tracks.clear();
+}
+
+bool DeadReckoning::project(const QString& mmsi, qint64 nowMs, double& latitude, double& longitude) const
+{
+    auto it = tracks.constFind(mmsi);
+    if (it == tracks.constEnd()) return false;
+
+    projectTrack(*it, nowMs, latitude, longitude);
+    return true;
+}
+
+QVector<ProjectedPosition> DeadReckoning::movingInBounds(qint64 nowMs, const QRectF& bounds)
+{
+    QVector<ProjectedPosition> result;
+    for (auto it = tracks.begin(); it != tracks.end(); ++it) {
+        if (!isMoving(*it, nowMs)) {
+            // 曾经外推过的船超时后再发送一次最后定位
+            bool hasVelocity = it->latPerMs != 0 || it->lngPerMs != 0;
+            if (!hasVelocity || it->settled) continue;
+            it->settled = true;
+        }
+
+        ProjectedPosition pos;
+        pos.mmsi = it.key();
+        projectTrack(*it, nowMs, pos.latitude, pos.longitude);
+        if (bounds.contains(pos.longitude, pos.latitude)) {
+            result.append(pos);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,50 @@
+#ifndef DEADRECKONING_H
+#define DEADRECKONING_H
+
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QRectF>
+
+struct ProjectedPosition {
+    QString mmsi;
+    double latitude = 0;
+    double longitude = 0;
+};
+
+// 航位推算：根据最后一次定位的航速/航向/时间推算船舶当前位置，
+// 两次报告之间（B类船可能超过30秒）地图上也能平滑移动。
+// 收到新定位时不直接跳到新位置，而是把推算误差在短时间内逐渐消除。
+// 推算以本机收到定位的时间为起点，不使用报文自带的时间戳（回放日志时可能相差很远）。
+class DeadReckoning {
+public:
+    void updateFix(const QString& mmsi, double latitude, double longitude,
+                   double sog, double cog);
+    void remove(const QString& mmsi);
+    void clear();
+
+    bool project(const QString& mmsi, qint64 nowMs, double& latitude, double& longitude) const;
+
+    // 视野内正在移动（或仍在修正误差）的船舶，静止的船无需每帧发送；
+    // 刚超过外推时限的船也返回一次，让标记回到最后定位
+    QVector<ProjectedPosition> movingInBounds(qint64 nowMs, const QRectF& bounds);
+
+private:
+    struct Track {
+        double latitude;
+        double longitude;
+        double latPerMs;     // 纬度变化速度（度/毫秒）
+        double lngPerMs;
+        qint64 arrivalMs;    // 本机收到该定位的时间
+        double errLat;       // 新定位到达时显示位置与真实位置之差
+        double errLng;
+        bool settled;        // 超时后已退回最后定位
+    };
+
+    static void projectTrack(const Track& track, qint64 nowMs, double& latitude, double& longitude);
+    static bool isMoving(const Track& track, qint64 nowMs);
+
+    QHash<QString, Track> tracks;
+};
+
+#endif // DEADRECKONING_H
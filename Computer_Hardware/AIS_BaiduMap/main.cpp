@@ -1,10 +1,137 @@
 #include "mapwindow.h"
+#include "positionstore.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <cstring>
+#include <limits>
+
+// 命令行历史查询：解码AIS日志后按时间段和区域输出位置（CSV）
+// 日志行可带ISO时间前缀，例如 "2025-06-01T08:00:00 !AIVDM,..."，否则按读取时间计
+static int runHistoryQuery(const QCommandLineParser& parser)
+{
+    QStringList box = parser.value("query").split(',');
+    if (box.size() != 4) {
+        QTextStream(stderr) << "--query 格式应为 西经,南纬,东经,北纬\n";
+        return 1;
+    }
+    QRectF bounds(QPointF(box[0].toDouble(), box[1].toDouble()),
+                  QPointF(box[2].toDouble(), box[3].toDouble()));
+
+    // 未指定--to时不限结束时间：无时间前缀的日志行按读取时间计，晚于此处的当前时间
+    QDateTime from = parser.isSet("from") ? QDateTime::fromString(parser.value("from"), Qt::ISODate)
+                                          : QDateTime::fromMSecsSinceEpoch(0);
+    QDateTime to = parser.isSet("to") ? QDateTime::fromString(parser.value("to"), Qt::ISODate)
+                                      : QDateTime();
+    if (!from.isValid() || (parser.isSet("to") && !to.isValid())) {
+        QTextStream(stderr) << "--from/--to 应为ISO时间，例如 2025-06-01T08:00:00\n";
+        return 1;
+    }
+    qint64 fromMs = from.toMSecsSinceEpoch();
+    qint64 toMs = to.isValid() ? to.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+
+    QFile file(parser.value("file"));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QTextStream(stderr) << "无法打开AIS日志: " << file.fileName() << "\n";
+        return 1;
+    }
+
+    PositionStore store(60 * 60 * 1000, 0);
+    QTextStream stream(&file);
+    QDateTime readTime = QDateTime::currentDateTime();
+    while (!stream.atEnd()) {
+        QString line = stream.readLine().trimmed();
+        QDateTime timestamp = readTime;
+
+        int start = line.indexOf('!');
+        if (start > 0) {
+            QDateTime prefix = QDateTime::fromString(line.left(start).trimmed(), Qt::ISODate);
+            if (prefix.isValid()) timestamp = prefix;
+            line = line.mid(start);
+        }
+        if (!line.startsWith("!AIVDM") && !line.startsWith("!ABVDM")) continue;
+
+        try {
+            AisMessage msg = AisAnal::parseLine(line, timestamp);
+            if (!ShipClusterIndex::isValidPosition(msg.latitude, msg.longitude)) continue;
+
+            PositionRecord record;
+            record.timeMs = timestamp.toMSecsSinceEpoch();
+            record.latitude = msg.latitude;
+            record.longitude = msg.longitude;
+            record.mmsi = msg.mmsi.toUInt();
+            record.sog = msg.sog;
+            record.cog = msg.cog;
+            store.append(record);
+        } catch (const std::exception&) {
+            // 无法解析的报文直接跳过
+        }
+    }
+
+    QElapsedTimer cost;
+    cost.start();
+    QTextStream out(stdout);
+    qint64 total = 0;
+    out << "time,mmsi,lat,lng,sog,cog\n";
+    store.query(fromMs, toMs, bounds,
+                [&out, &total](const QVector<PositionRecord>& chunk) {
+        for (const auto& r : chunk) {
+            out << QDateTime::fromMSecsSinceEpoch(r.timeMs).toString(Qt::ISODate) << ','
+                << r.mmsi << ',' << QString::number(r.latitude, 'f', 6) << ','
+                << QString::number(r.longitude, 'f', 6) << ',' << r.sog << ',' << r.cog << '\n';
+        }
+        total += chunk.size();
+        return true;
+    });
+    out.flush();
+
+    QTextStream(stderr) << "共 " << total << " 条位置（库中 " << store.size() << " 条），查询耗时 "
+                        << cost.nsecsElapsed() / 1e6 << " ms\n";
+    return 0;
+}
+
+static void addOptions(QCommandLineParser& parser)
+{
+    parser.addHelpOption();
+    parser.addOptions({
+        {"query", "按区域查询历史位置并退出，格式：西经,南纬,东经,北纬", "box"},
+        {"from", "查询起始时间（ISO格式）", "time"},
+        {"to", "查询结束时间（ISO格式）", "time"},
+        {"file", "AIS日志文件，默认使用内置报文", "path", ":/Resources/messages.txt"},
+    });
+}
+
+// 在创建应用对象之前判断是否为命令行查询，查询模式不需要图形界面
+static bool isQueryMode(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--query") == 0 || std::strncmp(argv[i], "--query=", 8) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
 
 int main(int argc, char *argv[])
 {
+    if (isQueryMode(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        QCommandLineParser parser;
+        addOptions(parser);
+        parser.process(app);
+        return runHistoryQuery(parser);
+    }
+
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    addOptions(parser);
+    parser.process(a);
+
     MapWindow w;
     w.show();
     return a.exec();
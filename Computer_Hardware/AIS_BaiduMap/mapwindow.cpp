@@ -9,6 +9,80 @@
 #include <QResource>
 #include <QTextStream>
 #include <QWebChannel>
+#include <QScreen>
+#include <QInputDialog>
+#include <QSet>
+#include <QtConcurrent>
+#include "shipsnapshot.h"
+#include <algorithm>
+
+// 快照中超过该时长未更新的船舶不再恢复
+static const qint64 kSnapshotMaxAgeMs = 30 * 60 * 1000;
+
+static ShipShmRecord toShmRecord(const AisMessage& msg)
+{
+    ShipShmRecord record;
+    record.mmsi = msg.mmsi.toUInt();
+    record.type = msg.type;
+    record.latitude = msg.latitude;
+    record.longitude = msg.longitude;
+    record.sog = msg.sog;
+    record.cog = msg.cog;
+    record.heading = msg.heading;
+    record.shipType = msg.shipType.toInt();
+    record.timestampMs = msg.timestamp.toMSecsSinceEpoch();
+    qstrncpy(record.name, msg.name.toLatin1().constData(), sizeof(record.name));
+    qstrncpy(record.callsign, msg.callsign.toLatin1().constData(), sizeof(record.callsign));
+    qstrncpy(record.destination, msg.destination.toLatin1().constData(), sizeof(record.destination));
+    return record;
+}
+
+// 带位置信息的报文类型
+static bool hasPosition(int type)
+{
+    return type == 1 || type == 2 || type == 3 || type == 4 || type == 18 || type == 21;
+}
+
+// 把一条报文合并到已有船舶记录：位置报文只更新动态字段，
+// 5号报文只更新静态字段，避免互相覆盖
+static void mergeShipState(AisMessage& ship, const AisMessage& message)
+{
+    ship.type = message.type;
+    ship.timestamp = message.timestamp;
+    ship.rawPayload = message.rawPayload;
+    ship.error = message.error;
+
+    if (message.type == 1 || message.type == 2 || message.type == 3 || message.type == 18) {
+        ship.latitude = message.latitude;
+        ship.longitude = message.longitude;
+        ship.sog = message.sog;
+        ship.cog = message.cog;
+        ship.heading = message.heading;
+    } else if (message.type == 4) {
+        ship.latitude = message.latitude;
+        ship.longitude = message.longitude;
+        ship.positionAccuracy = message.positionAccuracy;
+        ship.fixType = message.fixType;
+    } else if (message.type == 5) {
+        ship.imo = message.imo;
+        ship.callsign = message.callsign;
+        ship.name = message.name;
+        ship.shipType = message.shipType;
+        ship.dimensionToBow = message.dimensionToBow;
+        ship.dimensionToStern = message.dimensionToStern;
+        ship.dimensionToPort = message.dimensionToPort;
+        ship.dimensionToStarboard = message.dimensionToStarboard;
+        ship.destination = message.destination;
+    } else if (message.type == 21) {
+        ship.aidType = message.aidType;
+        ship.name = message.name;
+        ship.aidName = message.aidName;
+        ship.latitude = message.latitude;
+        ship.longitude = message.longitude;
+        ship.isOffPosition = message.isOffPosition;
+        ship.isVirtual = message.isVirtual;
+    }
+}
 
 MapWindow::MapWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -37,13 +111,11 @@ MapWindow::MapWindow(QWidget *parent)
         }
     });
 
-    // 连接网页消息处理
+    // 地图重新加载后立即补画已有船舶（包括从快照恢复的）
     connect(WebPages, &QWebEnginePage::loadFinished, this, [this]() {
-        WebPages->runJavaScript("window.addEventListener('message', function(event) {"
-                                "   if (event.data && event.data.type === 'ship_clicked') {"
-                                "       qtObject.handleWebPageMessage(event.data);"
-                                "   }"
-                                "});");
+        if (!aisMessages.empty()) {
+            updateShipMarkers();
+        }
     });
 
     // 暴露Qt对象给JavaScript
@@ -54,9 +126,37 @@ MapWindow::MapWindow(QWidget *parent)
     // 连接定时器
     connect(messageTimer, &QTimer::timeout, this, &MapWindow::processNextMessage);
 
+    // 地图刷新间隔：可用环境变量 AIS_FRAME_BUDGET_MS 指定，否则跟随屏幕刷新率
+    int frameBudget = qEnvironmentVariableIntValue("AIS_FRAME_BUDGET_MS");
+    qreal refreshRate = screen() ? screen()->refreshRate() : 0;
+    if (frameBudget > 0) {
+        scheduler.setFrameInterval(frameBudget);
+    } else if (refreshRate > 0) {
+        scheduler.setFrameInterval(1000.0 / refreshRate);
+    }
+
+    // 不支持POSIX共享内存的平台或已有其他实例在发布时打开失败，不影响其他功能
+    if (!shmWriter.open()) {
+        qDebug() << "共享内存发布未启用";
+    }
+
+    // 先恢复上次的船舶快照，再加载地图
+    snapshotPath = ShipSnapshot::defaultPath();
+    restoreSnapshot();
+
     on_pushButton_LoadBaiduMaps_clicked();
     loadAisMessagesFromResource(); // 预加载AIS报文
 
+    // 航位推算动画：与地图刷新同频，但不低于50ms一帧以控制桥接负载
+    renderTimer = new QTimer(this);
+    connect(renderTimer, &QTimer::timeout, this, &MapWindow::renderShipFrame);
+    renderTimer->start(qMax(50, qRound(scheduler.frameInterval())));
+
+    // 定期在后台写快照，不阻塞报文处理
+    snapshotTimer = new QTimer(this);
+    connect(snapshotTimer, &QTimer::timeout, this, &MapWindow::saveSnapshot);
+    snapshotTimer->start(10000);
+
     timer = new QTimer(this);
     connect(timer, &QTimer::timeout, this, &MapWindow::updateTime);
     timer->start(1000);  // 每秒钟更新一次时间
@@ -67,6 +167,12 @@ MapWindow::MapWindow(QWidget *parent)
 
 MapWindow::~MapWindow()
 {
+    // 退出前同步写一次最新快照
+    snapshotFuture.waitForFinished();
+    if (snapshotDirty) {
+        ShipSnapshot::save(aisMessages, snapshotPath);
+    }
+
     delete shipCounterLabel;
     delete ui;
 }
@@ -126,7 +232,7 @@ void MapWindow::updateShipCounterLabel()
         // 检查 shipCounterLabel 是否已初始化
         if (!shipCounterLabel) {
             shipCounterLabel = new QLabel(this);
-            shipCounterLabel->move(600, 20);  // 设置位置
+            shipCounterLabel->move(720, 20);  // 设置位置
             shipCounterLabel->setStyleSheet("QLabel {"
                                                    "background-color: #4CAF50; "  // 背景颜色
                                                    "color: white; "               // 字体颜色
@@ -153,21 +259,110 @@ void MapWindow::updateShipCounterLabel()
 void MapWindow::addAisMessage(const AisMessage &message)
 {
     // 查找是否已存在相同MMSI的船舶
-    auto it = std::find_if(aisMessages.begin(), aisMessages.end(),
-                           [&message](const AisMessage& m) { return m.mmsi == message.mmsi; });
+    auto found = shipIndexByMmsi.constFind(message.mmsi);
+    std::vector<AisMessage>::iterator it;
 
-    if (it != aisMessages.end()) {
-        *it = message; // 更新现有船舶
+    if (found != shipIndexByMmsi.constEnd()) {
+        it = aisMessages.begin() + found.value();
+        mergeShipState(*it, message); // 更新现有船舶
     } else {
+        shipIndexByMmsi.insert(message.mmsi, static_cast<int>(aisMessages.size()));
         aisMessages.push_back(message); // 添加新船舶
+        it = aisMessages.end() - 1;
 
         shipCounter++;
         updateShipCounterLabel();
     }
+    const AisMessage& ship = *it;
+
+    clusterIndex.update(ship.mmsi, ship.latitude, ship.longitude);
+
+    if (hasPosition(message.type)) {
+        deadReckoning.updateFix(ship.mmsi, ship.latitude, ship.longitude, ship.sog, ship.cog);
+
+        // 每条有效定位都追加到历史库
+        if (ShipClusterIndex::isValidPosition(ship.latitude, ship.longitude)) {
+            PositionRecord record;
+            // 历史库按报文时间记录，与推算使用的到达时间无关
+            record.timeMs = message.timestamp.isValid() ? message.timestamp.toMSecsSinceEpoch()
+                                                        : QDateTime::currentMSecsSinceEpoch();
+            record.latitude = ship.latitude;
+            record.longitude = ship.longitude;
+            record.mmsi = ship.mmsi.toUInt();
+            record.sog = ship.sog;
+            record.cog = ship.cog;
+            historyStore.append(record);
+        }
+    }
+    shmWriter.publish(toShmRecord(ship));
+    snapshotDirty = true;
+}
+
+void MapWindow::saveSnapshot()
+{
+    // 上一次写入尚未完成或没有变化时跳过
+    if (!snapshotDirty || snapshotFuture.isRunning()) {
+        return;
+    }
+
+    // QString隐式共享，复制船舶表只增加引用计数，写盘在后台线程完成
+    std::vector<AisMessage> ships = aisMessages;
+    snapshotFuture = QtConcurrent::run([ships = std::move(ships), path = snapshotPath]() {
+        return ShipSnapshot::save(ships, path);
+    });
+    snapshotDirty = false;
+}
+
+void MapWindow::restoreSnapshot()
+{
+    snapshotFuture.waitForFinished();
+
+    std::vector<AisMessage> ships;
+    if (!ShipSnapshot::load(snapshotPath, ships)) {
+        return;
+    }
+
+    // 太久没有报告的船可能早已离开，不再恢复
+    QDateTime oldest = QDateTime::currentDateTime().addMSecs(-kSnapshotMaxAgeMs);
+    ships.erase(std::remove_if(ships.begin(), ships.end(), [&oldest](const AisMessage& msg) {
+        return !msg.timestamp.isValid() || msg.timestamp < oldest;
+    }), ships.end());
+
+    aisMessages.swap(ships);
+    shipIndexByMmsi.clear();
+    for (int i = 0; i < static_cast<int>(aisMessages.size()); i++) {
+        shipIndexByMmsi.insert(aisMessages[i].mmsi, i);
+    }
+    clusterIndex.clear();
+    deadReckoning.clear();
+    // 快照中的定位不知已过去多久，恢复后只显示最后位置，不做外推；
+    // 共享内存中标记为恢复的记录，收到该船新报文后才算实时数据
+    for (const auto& msg : aisMessages) {
+        clusterIndex.update(msg.mmsi, msg.latitude, msg.longitude);
+        deadReckoning.updateFix(msg.mmsi, msg.latitude, msg.longitude, 0, msg.cog);
+        ShipShmRecord record = toShmRecord(msg);
+        record.flags |= kShipShmRestored;
+        shmWriter.publish(record);
+    }
+    shipCounter = static_cast<int>(aisMessages.size());
+    qDebug() << "已从快照恢复船舶数:" << shipCounter;
+
+    updateShipCounterLabel();
+    updateShipMarkers();
 }
 
 void MapWindow::updateShipMarkers()
 {
+    WebPages->runJavaScript(shipMarkersScript());
+}
+
+QString MapWindow::shipMarkersScript()
+{
+    // 缩放级别较低时只发送聚合结果
+    if (mapZoom < ShipClusterIndex::kClusterMaxZoom && mapBounds.isValid()) {
+        return shipClustersScript();
+    }
+
     // 使用局部变量减少锁定时间
     std::vector<AisMessage> messagesCopy;
     {
@@ -175,7 +370,8 @@ void MapWindow::updateShipMarkers()
     }
 
     QJsonArray shipsArray;
-    qDebug() << "准备更新船舶标记，当前船舶数:" << messagesCopy.size();
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
 
     for (const auto& msg : messagesCopy) {
         // 验证坐标有效性
@@ -186,17 +382,27 @@ void MapWindow::updateShipMarkers()
             continue;
         }
 
+        // 使用推算位置，避免与逐帧动画的位置来回跳动
+        double lat = msg.latitude;
+        double lng = msg.longitude;
+        deadReckoning.project(msg.mmsi, now, lat, lng);
+
+        // 只发送视野内的船舶
+        if (mapBounds.isValid() && !mapBounds.contains(lng, lat)) {
+            continue;
+        }
+
         QJsonObject ship;
         ship["mmsi"] = msg.mmsi;
-        ship["lat"] = msg.latitude;
-        ship["lng"] = msg.longitude;
+        ship["lat"] = lat;
+        ship["lng"] = lng;
         ship["cog"] = msg.cog;
         ship["name"] = msg.name.isEmpty() ? "MMSI:" + msg.mmsi : msg.name;
         shipsArray.append(ship);
     }
 
     // 如果没有有效数据，添加测试数据
-    if (shipsArray.isEmpty()) {
+    if (shipsArray.isEmpty() && messagesCopy.empty()) {
         qWarning() << "无有效船舶数据，注入测试数据";
         QJsonObject testShip;
         testShip["mmsi"] = "TEST123";
@@ -207,24 +413,133 @@ void MapWindow::updateShipMarkers()
     }
 
     // 转换为JSON字符串
-    QString jsonStr = QJsonDocument(shipsArray).toJson();
-
-    // 使用QMetaObject::invokeMethod确保在UI线程执行
-    QMetaObject::invokeMethod(this, [this, jsonStr]() {
-        QString js = QString(
-                         "try {"
-                         "   if (typeof updateShipMarkers === 'function') {"
-                         "       updateShipMarkers(%1);"
-                         "   } else {"
-                         "       console.error('updateShipMarkers函数未定义!');"
-                         "   }"
-                         "} catch(e) { console.error('JS执行错误:', e); }"
-                         ).arg(jsonStr);
-
-        WebPages->runJavaScript(js, [](const QVariant &result) {
-            // qDebug() << "JavaScript调用完成";
-        });
-    }, Qt::QueuedConnection);
+    QString jsonStr = QJsonDocument(shipsArray).toJson(QJsonDocument::Compact);
+
+    return QString(
+               "try {"
+               "   if (typeof updateShipMarkers === 'function') {"
+               "       updateShipMarkers(%1);"
+               "   } else {"
+               "       console.error('updateShipMarkers函数未定义!');"
+               "   }"
+               "} catch(e) { console.error('JS执行错误:', e); }"
+               ).arg(jsonStr);
+}
+
+QString MapWindow::shipClustersScript()
+{
+    QVector<ShipCluster> clusters = clusterIndex.query(mapZoom, mapBounds);
+
+    QJsonArray clustersArray;
+    for (const auto& cluster : clusters) {
+        QJsonObject item;
+        item["lat"] = cluster.latitude;
+        item["lng"] = cluster.longitude;
+        item["count"] = cluster.count;
+        item["cell"] = QString("%1:%2").arg(mapZoom).arg(cluster.cell);
+
+        // 单船网格按普通船舶标记发送
+        auto found = shipIndexByMmsi.constFind(cluster.mmsi);
+        if (!cluster.mmsi.isEmpty() && found != shipIndexByMmsi.constEnd()) {
+            const AisMessage& msg = aisMessages[found.value()];
+            item["mmsi"] = msg.mmsi;
+            item["cog"] = msg.cog;
+            item["name"] = msg.name.isEmpty() ? "MMSI:" + msg.mmsi : msg.name;
+        }
+        clustersArray.append(item);
+    }
+
+    QString jsonStr = QJsonDocument(clustersArray).toJson(QJsonDocument::Compact);
+
+    return QString(
+               "try {"
+               "   if (typeof updateShipClusters === 'function') {"
+               "       updateShipClusters(%1);"
+               "   } else {"
+               "       console.error('updateShipClusters函数未定义!');"
+               "   }"
+               "} catch(e) { console.error('JS执行错误:', e); }"
+               ).arg(jsonStr);
+}
+
+void MapWindow::renderShipFrame()
+{
+    // 聚合显示时没有单船标记可移动
+    if (mapZoom < ShipClusterIndex::kClusterMaxZoom || !mapBounds.isValid()) {
+        return;
+    }
+
+    QVector<ProjectedPosition> positions =
+        deadReckoning.movingInBounds(QDateTime::currentMSecsSinceEpoch(), mapBounds);
+    if (positions.isEmpty()) {
+        return;
+    }
+
+    // 紧凑格式：[mmsi, lat, lng, mmsi, lat, lng, ...]
+    QJsonArray batch;
+    for (const auto& pos : positions) {
+        batch.append(pos.mmsi);
+        batch.append(pos.latitude);
+        batch.append(pos.longitude);
+    }
+
+    QString js = QString("if (typeof moveShipMarkers === 'function') { moveShipMarkers(%1); }")
+                     .arg(QString::fromUtf8(QJsonDocument(batch).toJson(QJsonDocument::Compact)));
+    WebPages->runJavaScript(js);
+}
+
+int MapWindow::queryHistory(const QDateTime& from, const QDateTime& to, const QRectF& bounds)
+{
+    WebPages->runJavaScript("if (typeof clearHistoryPositions === 'function') { clearHistoryPositions(); }");
+
+    QElapsedTimer cost;
+    cost.start();
+    int total = 0;
+    QSet<quint32> ships;
+
+    historyStore.query(from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch(), bounds,
+                       [this, &total, &ships](const QVector<PositionRecord>& chunk) {
+        // 紧凑格式：[mmsi, lat, lng, mmsi, lat, lng, ...]
+        QJsonArray batch;
+        for (const auto& record : chunk) {
+            batch.append(QString::number(record.mmsi));
+            batch.append(record.latitude);
+            batch.append(record.longitude);
+            ships.insert(record.mmsi);
+        }
+        total += chunk.size();
+
+        QString js = QString("if (typeof showHistoryPositions === 'function') { showHistoryPositions(%1); }")
+                         .arg(QString::fromUtf8(QJsonDocument(batch).toJson(QJsonDocument::Compact)));
+        WebPages->runJavaScript(js);
+        return true;
+    });
+
+    qDebug() << "历史查询完成，位置数:" << total << "船舶数:" << ships.size()
+             << "耗时(ms):" << cost.nsecsElapsed() / 1e6;
+    return ships.size();
+}
+
+void MapWindow::flushShipMarkers()
+{
+    // 上一次刷新在网页中尚未执行完时不叠加新的刷新，脏标记保留到下次
+    if (flushInFlight) {
+        return;
+    }
+    flushInFlight = true;
+    markersDirty = false;
+
+    // 计时覆盖C++构造数据和网页重绘标记的完整往返
+    flushClock.start();
+    WebPages->runJavaScript(shipMarkersScript(), [this](const QVariant &) {
+        scheduler.recordFlush(flushClock.nsecsElapsed() / 1e6);
+        flushInFlight = false;
+
+        // 处理已停止（完成、暂停或视野变化）时补上期间积累的更新
+        if (markersDirty && !messageTimer->isActive()) {
+            flushShipMarkers();
+        }
+    });
 }
 
 void MapWindow::showPlainTextEdit()
@@ -247,6 +562,10 @@ void MapWindow::showPlainTextEdit()
     cipherTextEdit->setReadOnly(true);
     plainTextEdit->setReadOnly(true);
 
+    // 限制保留行数，高速处理时文本框不会无限增长拖慢界面
+    cipherTextEdit->setMaximumBlockCount(1000);
+    plainTextEdit->setMaximumBlockCount(1000);
+
     // 设置样式
     QString textEditStyle = "font-size: 14px; "
                             "background-color: #f0f0f0; "
@@ -302,22 +621,29 @@ void MapWindow::on_pushButton_LoadBaiduMaps_clicked()
         }
     });
 
-    shipCounter = 0;
+    // 船舶表保持不变，只重建计数标签
+    shipCounter = static_cast<int>(aisMessages.size());
     currentMessageIndex = 0;
 
     delete shipCounterLabel;
 
     shipCounterLabel = nullptr;
 
+    updateShipCounterLabel();
 }
 
 void MapWindow::on_pushButton_LocateMaps_clicked()
 {
     aisMessages.clear();
+    shipIndexByMmsi.clear();
+    clusterIndex.clear();
+    deadReckoning.clear();
     clearAllMapLabels();
     shipCounter = 0;
     currentMessageIndex = 0;
 
+    // 用最近的快照补齐船舶表，避免静态信息需要几分钟才能重新收到
+    restoreSnapshot();
     updateShipCounterLabel();
 
     showPlainTextEdit(); // 先显示文本框
@@ -335,8 +661,8 @@ void MapWindow::on_pushButton_LocateMaps_clicked()
     cipherTextEdit->clear();
     plainTextEdit->clear();
 
-    // 启动定时器
-    messageTimer->start(200);
+    // 启动定时器（间隔0：事件循环空闲即处理，每次处理量由调度器按帧预算决定）
+    messageTimer->start(0);
 
     // 立即处理第一条消息（可选）
     if(!rawAisMessages.isEmpty()) {
@@ -344,6 +670,28 @@ void MapWindow::on_pushButton_LocateMaps_clicked()
     }
 }
 
+void MapWindow::on_pushButton_QueryHistory_clicked()
+{
+    // 无效范围会被当作不限区域，网页回报视野之前不查询
+    if (!mapBounds.isValid()) {
+        QMessageBox::information(this, "历史查询", "地图尚未加载完成，请稍后再试");
+        return;
+    }
+
+    bool ok = false;
+    int minutes = QInputDialog::getInt(this, "历史查询", "查询最近多少分钟内到过当前视野的船舶：",
+                                       60, 1, 24 * 60, 10, &ok);
+    if (!ok) return;
+
+    QDateTime to = QDateTime::currentDateTime();
+    QDateTime from = to.addSecs(-60 * minutes);
+    int ships = queryHistory(from, to, mapBounds);
+
+    QMessageBox::information(this, "历史查询",
+                             QString("最近 %1 分钟内共有 %2 艘船到过当前区域（共保存 %3 条历史位置）")
+                                 .arg(minutes).arg(ships).arg(historyStore.size()));
+}
+
 void MapWindow::on_btnHidePlainTextEdits_clicked()
 {
     if (hideOrNot == 0) {
@@ -366,7 +714,7 @@ void MapWindow::on_btnPauseResume_clicked()
         btnPauseResume->setText("继续接收");
         isProcessing = false;
     } else {
-        messageTimer->start(200);
+        messageTimer->start(0);
         btnPauseResume->setText("暂停接收");
         isProcessing = true;
     }
@@ -374,21 +722,27 @@ void MapWindow::on_btnPauseResume_clicked()
 
 void MapWindow::processNextMessage() {
     if (currentMessageIndex >= rawAisMessages.size()) {
+        if (markersDirty) {
+            flushShipMarkers();
+        }
         messageTimer->stop();
         btnPauseResume->setText("处理完成");
         btnPauseResume->setEnabled(false);
         return;
     }
 
-    // 限制每次处理的消息数量
-    int messagesToProcess = qMin(10, rawAisMessages.size() - currentMessageIndex);
+    // 每次处理的数量由调度器按帧预算动态决定
+    QStringList cipherLines;
+    QStringList plainLines;
+    int processed = 0;
 
-    for (int i = 0; i < messagesToProcess; i++) {
+    scheduler.beginTick();
+    while (currentMessageIndex < rawAisMessages.size() && scheduler.canContinue(processed)) {
         const QPair<QDateTime, QString>& messagePair = rawAisMessages[currentMessageIndex];
         QDateTime timestamp = messagePair.first;
         QString rawMessage = messagePair.second;
 
-        cipherTextEdit->appendPlainText("[" + timestamp.toString("hh:mm:ss") + "] " + rawMessage);
+        cipherLines.append("[" + timestamp.toString("hh:mm:ss") + "] " + rawMessage);
 
         try {
             AisMessage msg = AisAnal::parseLine(rawMessage, timestamp);
@@ -402,55 +756,39 @@ void MapWindow::processNextMessage() {
                                     .arg(msg.sog)
                                     .arg(msg.cog);
 
-            plainTextEdit->appendPlainText(plainText);
+            plainLines.append(plainText);
             addAisMessage(msg);
+            markersDirty = true;
 
         } catch (const std::exception& e) {
-            plainTextEdit->appendPlainText("[" + timestamp.toString("hh:mm:ss") + "] 解析错误: " + QString(e.what()));
+            plainLines.append("[" + timestamp.toString("hh:mm:ss") + "] 解析错误: " + QString(e.what()));
         }
 
         currentMessageIndex++;
+        processed++;
     }
+    scheduler.endTick(processed);
+
+    // 整批追加到文本框，减少重排次数
+    cipherTextEdit->appendPlainText(cipherLines.join('\n'));
+    plainTextEdit->appendPlainText(plainLines.join('\n'));
 
-    // 批量更新船舶标记，而不是每条消息都更新
-    if (currentMessageIndex % 20 == 0 || currentMessageIndex >= rawAisMessages.size()) {
-        updateShipMarkers();
+    // 地图刷新与解码解耦，按刷新间隔合并
+    if (markersDirty && (scheduler.shouldFlush() || currentMessageIndex >= rawAisMessages.size())) {
+        flushShipMarkers();
     }
 }
 
 void MapWindow::handleWebPageMessage(const QJsonObject &message)
 {
     QString action = message["action"].toString();
-    if (action == "ship_clicked") {
-        QString mmsi = message["mmsi"].toString();
-
-        for (const auto& msg : aisMessages) {
-            if (msg.mmsi == mmsi) {
-                QString info = QString("<b>船舶详细信息</b><br><br>"
-                                       "<b>MMSI:</b> %1<br>"
-                                       "<b>船名:</b> %2<br>"
-                                       "<b>位置:</b> %3°N, %4°E<br>"
-                                       "<b>航速:</b> %5 节<br>"
-                                       "<b>航向:</b> %6°<br>"
-                                       "<b>首向:</b> %7°<br>"
-                                       "<b>报文类型:</b> %8<br>"
-                                       "<b>最后更新时间:</b> %9<br>"
-                                       "<b>原始报文:</b> %10")
-                                   .arg(msg.mmsi)
-                                   .arg(msg.name.isEmpty() ? "未知" : msg.name)
-                                   .arg(msg.latitude, 0, 'f', 6)
-                                   .arg(msg.longitude, 0, 'f', 6)
-                                   .arg(msg.sog)
-                                   .arg(msg.cog)
-                                   .arg(msg.heading < 0 ? "未知" : QString::number(msg.heading))
-                                   .arg(msg.type)
-                                   .arg(msg.timestamp.toString("yyyy-MM-dd hh:mm:ss"))
-                                   .arg(msg.rawPayload);
-
-                QMessageBox::information(this, "船舶详细信息", info);
-                break;
-            }
-        }
+    if (action == "view_changed") {
+        // 视野变化后按新的缩放级别和范围重新发送
+        mapZoom = message["zoom"].toInt();
+        mapBounds = QRectF(QPointF(message["west"].toDouble(), message["south"].toDouble()),
+                           QPointF(message["east"].toDouble(), message["north"].toDouble()));
+        markersDirty = true;
+        flushShipMarkers();
     }
 }
 
@@ -10,7 +10,13 @@
 #include <QPushButton>
 #include <QTimer>
 #include <QLabel>
+#include <QFuture>
 #include "ais_anal.h"
+#include "messagescheduler.h"
+#include "shipcluster.h"
+#include "shipshm.h"
+#include "deadreckoning.h"
+#include "positionstore.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MapWindow; }
@@ -31,6 +37,17 @@ public:
 
     void updateShipCounterLabel();
 
+    void flushShipMarkers();
+    QString shipMarkersScript();
+    QString shipClustersScript();
+    void renderShipFrame();
+
+    // 查询某时间段内到过指定区域的船舶位置，结果分块推送到地图
+    int queryHistory(const QDateTime& from, const QDateTime& to, const QRectF& bounds);
+
+    void saveSnapshot();
+    void restoreSnapshot();
+
 private:
     Ui::MapWindow *ui;
     int windowHeight = 0;
@@ -40,10 +57,27 @@ private:
     int hideOrNot = -1;
     bool isProcessing = false;
     int currentMessageIndex = 0;
+    bool markersDirty = false;
+    bool flushInFlight = false;
+    QElapsedTimer flushClock;
+
+    MessageScheduler scheduler;
+
+    // 地图当前视野，由网页在缩放/拖动后回报
+    ShipClusterIndex clusterIndex;
+    int mapZoom = 11;
+    QRectF mapBounds;
+
+    // 两次定位之间按航速航向推算位置，每帧只发送视野内移动的船
+    DeadReckoning deadReckoning;
+    QTimer *renderTimer;
+
+    PositionStore historyStore;
 
     int shipCounter = 0;
 
     std::vector<AisMessage> aisMessages;
+    QHash<QString, int> shipIndexByMmsi;   // MMSI -> aisMessages下标
     QVector<QPair<QDateTime, QString>> rawAisMessages;
 
     QWebEnginePage *WebPages;
@@ -54,22 +88,34 @@ private:
     QPushButton *btnPauseResume;
     QTimer *messageTimer;
     QTimer *timer;
+    QTimer *snapshotTimer;
+
+    QString snapshotPath;
+    QFuture<bool> snapshotFuture;
+    bool snapshotDirty = false;
+
+    // 发布到共享内存，供本机其他进程读取
+    ShipShmWriter shmWriter;
 
     QLabel *shipCounterLabel;
 
     QString strMapPaths, strExePaths;
     QDir qDirs;
 
+public slots:
+    // QWebChannel 只向网页公开 public 槽
+    void handleWebPageMessage(const QJsonObject& message);
+
 protected:
     void resizeEvent(QResizeEvent *event) override;
 
 private slots:
     void on_pushButton_LoadBaiduMaps_clicked();
     void on_pushButton_LocateMaps_clicked();
+    void on_pushButton_QueryHistory_clicked();
     void on_btnHidePlainTextEdits_clicked();
     void on_btnPauseResume_clicked();
     void processNextMessage();
-    void handleWebPageMessage(const QJsonObject& message);
     void updateTime();
     void clearAllMapLabels();
 };
@@ -0,0 +1,52 @@
+#include "messagescheduler.h"
+#include <QtGlobal>
+
+MessageScheduler::MessageScheduler(double frameIntervalMs)
+{
+    setFrameInterval(frameIntervalMs);
+    flushTimer.start();
+}
+
+void MessageScheduler::setFrameInterval(double ms)
+{
+    frameIntervalMs = qMax(1.0, ms);
+    tickBudgetMs = frameIntervalMs / 2;
+}
+
+void MessageScheduler::beginTick()
+{
+    tickTimer.start();
+}
+
+bool MessageScheduler::canContinue(int processed) const
+{
+    if (processed >= batch) return false;
+    // 单条报文耗时估计偏差较大时，以实际耗时兜底
+    return tickTimer.nsecsElapsed() / 1e6 < tickBudgetMs;
+}
+
+void MessageScheduler::endTick(int processed)
+{
+    if (processed <= 0) return;
+
+    double elapsedMs = tickTimer.nsecsElapsed() / 1e6;
+    double cost = elapsedMs / processed;
+    msgCostMs += kSmoothing * (cost - msgCostMs);
+
+    // 根据单条耗时计算下一次能放进预算的报文数
+    int target = static_cast<int>(tickBudgetMs / qMax(msgCostMs, 1e-3));
+    batch = qBound(kMinBatch, target, kMaxBatch);
+}
+
+bool MessageScheduler::shouldFlush() const
+{
+    // 刷新本身很贵时拉长间隔，保证刷新最多占用约四分之一的时间
+    double interval = qMax(frameIntervalMs, flushCostMs * 4);
+    return flushTimer.elapsed() >= interval;
+}
+
+void MessageScheduler::recordFlush(double costMs)
+{
+    flushCostMs += kSmoothing * (costMs - flushCostMs);
+    flushTimer.restart();
+}
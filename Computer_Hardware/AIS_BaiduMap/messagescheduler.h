@@ -0,0 +1,43 @@
+#ifndef MESSAGESCHEDULER_H
+#define MESSAGESCHEDULER_H
+
+#include <QElapsedTimer>
+
+// 报文处理调度器：按帧预算决定每次处理多少条报文、何时刷新地图。
+// 每次tick测量自身耗时，动态调整批量大小，既尽快消化积压，又不卡住界面。
+class MessageScheduler {
+public:
+    explicit MessageScheduler(double frameIntervalMs = 16.7);
+
+    // 刷新间隔（一般取显示器刷新周期），解码预算取其一半，另一半留给界面事件
+    void setFrameInterval(double ms);
+    double frameInterval() const { return frameIntervalMs; }
+
+    void beginTick();
+    // 本次tick是否还能继续处理下一条报文
+    bool canContinue(int processed) const;
+    void endTick(int processed);
+
+    // 距上次刷新超过刷新间隔（且刷新本身不会占满界面时间）时才刷新地图
+    bool shouldFlush() const;
+    void recordFlush(double costMs);
+
+    int batchSize() const { return batch; }
+    double messageCost() const { return msgCostMs; }
+
+private:
+    double frameIntervalMs;
+    double tickBudgetMs;
+    double msgCostMs = 0.1;   // 单条报文平均耗时（指数平滑）
+    double flushCostMs = 0;   // 单次地图刷新平均耗时（指数平滑）
+    int batch = 10;
+
+    QElapsedTimer tickTimer;
+    QElapsedTimer flushTimer;
+
+    static constexpr int kMinBatch = 1;
+    static constexpr int kMaxBatch = 5000;
+    static constexpr double kSmoothing = 0.2;
+};
+
+#endif // MESSAGESCHEDULER_H
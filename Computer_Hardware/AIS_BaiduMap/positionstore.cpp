@@ -0,0 +1,192 @@
+#include "positionstore.h"
+#include <QtMath>
+#include <algorithm>
+
+// R树每个节点的扇出
+static const int kNodeCapacity = 64;
+// 每批封存的记录数，满一批即为其单独建索引
+static const int kRunSize = 4096;
+
+PositionStore::PositionStore(qint64 segmentSpanMs, qint64 retentionMs)
+    : segmentSpanMs(qMax<qint64>(1, segmentSpanMs))
+    , retentionMs(retentionMs)
+{
+}
+
+PositionStore::Node PositionStore::makeNode(const PositionRecord* records, int first, int count)
+{
+    Node node;
+    node.minLat = node.maxLat = records[first].latitude;
+    node.minLng = node.maxLng = records[first].longitude;
+    node.minTime = node.maxTime = records[first].timeMs;
+    for (int i = first + 1; i < first + count; i++) {
+        const PositionRecord& r = records[i];
+        node.minLat = qMin(node.minLat, r.latitude);
+        node.maxLat = qMax(node.maxLat, r.latitude);
+        node.minLng = qMin(node.minLng, r.longitude);
+        node.maxLng = qMax(node.maxLng, r.longitude);
+        node.minTime = qMin(node.minTime, r.timeMs);
+        node.maxTime = qMax(node.maxTime, r.timeMs);
+    }
+    node.first = first;
+    node.count = count;
+    node.leaf = true;
+    return node;
+}
+
+PositionStore::Node PositionStore::makeParent(const QVector<Node>& nodes, int first, int count)
+{
+    Node node = nodes[first];
+    for (int i = first + 1; i < first + count; i++) {
+        const Node& child = nodes[i];
+        node.minLat = qMin(node.minLat, child.minLat);
+        node.maxLat = qMax(node.maxLat, child.maxLat);
+        node.minLng = qMin(node.minLng, child.minLng);
+        node.maxLng = qMax(node.maxLng, child.maxLng);
+        node.minTime = qMin(node.minTime, child.minTime);
+        node.maxTime = qMax(node.maxTime, child.maxTime);
+    }
+    node.first = first;
+    node.count = count;
+    node.leaf = false;
+    return node;
+}
+
+void PositionStore::indexRun(Segment& segment, int first, int count)
+{
+    // STR打包：先按经度切成S个竖条，条内再按纬度排序，每B条记录组成一个叶子
+    int leafCount = (count + kNodeCapacity - 1) / kNodeCapacity;
+    int sliceCount = qCeil(qSqrt(leafCount));
+    int sliceSize = sliceCount * kNodeCapacity;
+
+    auto begin = segment.records.begin() + first;
+    std::sort(begin, begin + count, [](const PositionRecord& a, const PositionRecord& b) {
+        return a.longitude < b.longitude;
+    });
+    for (int start = 0; start < count; start += sliceSize) {
+        std::sort(begin + start, begin + qMin(count, start + sliceSize),
+                  [](const PositionRecord& a, const PositionRecord& b) {
+            return a.latitude < b.latitude;
+        });
+    }
+
+    int levelStart = segment.nodes.size();
+    for (int i = 0; i < count; i += kNodeCapacity) {
+        segment.nodes.append(makeNode(segment.records.constData(), first + i, qMin(kNodeCapacity, count - i)));
+    }
+
+    // 逐层向上打包，相邻叶子已在同一竖条内，空间上是连续的
+    int levelCount = segment.nodes.size() - levelStart;
+    while (levelCount > 1) {
+        int nextStart = segment.nodes.size();
+        for (int i = 0; i < levelCount; i += kNodeCapacity) {
+            Node parent = makeParent(segment.nodes, levelStart + i, qMin(kNodeCapacity, levelCount - i));
+            segment.nodes.append(parent);
+        }
+        levelStart = nextStart;
+        levelCount = segment.nodes.size() - nextStart;
+    }
+    segment.roots.append(segment.nodes.size() - 1);
+    segment.indexedCount = first + count;
+}
+
+void PositionStore::append(const PositionRecord& record)
+{
+    qint64 key = record.timeMs - record.timeMs % segmentSpanMs;
+    if (record.timeMs < 0 && key != record.timeMs) key -= segmentSpanMs;
+
+    Segment& segment = segments[key];
+    segment.records.append(record);
+    totalRecords++;
+
+    if (segment.records.size() - segment.indexedCount >= kRunSize) {
+        indexRun(segment, segment.indexedCount, kRunSize);
+    }
+
+    // 丢弃超出保留期的整段
+    qint64 newest = segments.lastKey();
+    while (retentionMs > 0 && segments.firstKey() + segmentSpanMs <= newest - retentionMs) {
+        totalRecords -= segments.first().records.size();
+        segments.erase(segments.begin());
+    }
+}
+
+void PositionStore::clear()
+{
+    segments.clear();
+    totalRecords = 0;
+}
+
+void PositionStore::query(qint64 fromMs, qint64 toMs, const QRectF& bounds,
+                          const Sink& sink, int chunkSize) const
+{
+    const bool anyArea = !bounds.isValid();
+    const QRectF area = bounds.normalized();
+    const double west = area.left(), east = area.right();
+    const double south = area.top(), north = area.bottom();
+
+    chunkSize = qMax(1, chunkSize);
+    QVector<PositionRecord> chunk;
+    chunk.reserve(chunkSize);
+    bool stopped = false;
+
+    auto push = [&](const PositionRecord& r) {
+        if (r.timeMs < fromMs || r.timeMs > toMs) return;
+        if (!anyArea && (r.longitude < west || r.longitude > east
+                         || r.latitude < south || r.latitude > north)) return;
+
+        chunk.append(r);
+        if (chunk.size() >= chunkSize) {
+            stopped = !sink(chunk);
+            chunk.clear();
+        }
+    };
+
+    auto overlaps = [&](const Node& node) {
+        if (node.maxTime < fromMs || node.minTime > toMs) return false;
+        if (anyArea) return true;
+        return node.maxLng >= west && node.minLng <= east
+               && node.maxLat >= south && node.minLat <= north;
+    };
+
+    // 只访问与时间范围相交的分段
+    auto it = segments.upperBound(fromMs - segmentSpanMs);
+    for (; it != segments.constEnd() && it.key() <= toMs && !stopped; ++it) {
+        const Segment& segment = it.value();
+
+        QVector<int> stack(segment.roots);
+        while (!stack.isEmpty() && !stopped) {
+            const Node& node = segment.nodes[stack.takeLast()];
+            if (!overlaps(node)) continue;
+
+            if (node.leaf) {
+                for (int i = node.first; i < node.first + node.count && !stopped; i++) {
+                    push(segment.records[i]);
+                }
+            } else {
+                for (int i = node.first; i < node.first + node.count; i++) {
+                    stack.append(i);
+                }
+            }
+        }
+
+        // 尚未建索引的追加部分顺序扫描
+        for (int i = segment.indexedCount; i < segment.records.size() && !stopped; i++) {
+            push(segment.records[i]);
+        }
+    }
+
+    if (!stopped && !chunk.isEmpty()) {
+        sink(chunk);
+    }
+}
+
+QVector<PositionRecord> PositionStore::query(qint64 fromMs, qint64 toMs, const QRectF& bounds) const
+{
+    QVector<PositionRecord> result;
+    query(fromMs, toMs, bounds, [&result](const QVector<PositionRecord>& chunk) {
+        result += chunk;
+        return true;
+    });
+    return result;
+}
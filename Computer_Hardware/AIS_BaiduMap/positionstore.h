@@ -0,0 +1,66 @@
+#ifndef POSITIONSTORE_H
+#define POSITIONSTORE_H
+
+#include <QMap>
+#include <QRectF>
+#include <QVector>
+#include <functional>
+
+struct PositionRecord {
+    qint64 timeMs = 0;
+    double latitude = 0;
+    double longitude = 0;
+    quint32 mmsi = 0;
+    float sog = 0;
+    float cog = 0;
+};
+
+// 历史位置库：只追加，按时间分段（默认每小时一段）。段内每满固定条数封存为一批，
+// 每批只建一次STR打包的R树，已建索引的数据不再重排，追加的开销与库的大小无关。
+// 用于回答"某时间段内哪些船到过某区域"，结果按块流式返回。
+class PositionStore {
+public:
+    // 返回false时停止查询
+    using Sink = std::function<bool(const QVector<PositionRecord>& chunk)>;
+
+    explicit PositionStore(qint64 segmentSpanMs = 60 * 60 * 1000,
+                           qint64 retentionMs = 24 * 60 * 60 * 1000);
+
+    void append(const PositionRecord& record);
+    void clear();
+
+    // bounds: x为经度、y为纬度；无效的bounds表示不限区域
+    void query(qint64 fromMs, qint64 toMs, const QRectF& bounds,
+               const Sink& sink, int chunkSize = 2000) const;
+    QVector<PositionRecord> query(qint64 fromMs, qint64 toMs, const QRectF& bounds) const;
+
+    qint64 size() const { return totalRecords; }
+    int segmentCount() const { return segments.size(); }
+
+private:
+    struct Node {
+        double minLat, minLng, maxLat, maxLng;
+        qint64 minTime, maxTime;
+        int first;      // 叶子：records下标；内部节点：nodes下标
+        int count;
+        bool leaf;
+    };
+
+    struct Segment {
+        QVector<PositionRecord> records;
+        QVector<Node> nodes;
+        QVector<int> roots;     // 每个已封存批次的根节点
+        int indexedCount = 0;   // records前indexedCount条已建索引，其后为未索引的追加部分
+    };
+
+    static void indexRun(Segment& segment, int first, int count);
+    static Node makeNode(const PositionRecord* records, int first, int count);
+    static Node makeParent(const QVector<Node>& nodes, int first, int count);
+
+    qint64 segmentSpanMs;
+    qint64 retentionMs;
+    qint64 totalRecords = 0;
+    QMap<qint64, Segment> segments;   // 键为分段起始时间
+};
+
+#endif // POSITIONSTORE_H
@@ -0,0 +1,140 @@
+#include "shipcluster.h"
+#include <QtMath>
+#include <cmath>
+
+// 每个聚合网格约占屏幕64像素
+static const double kCellPixels = 64;
+// 百度地图缩放级别z时约为 2^(18-z) 米/像素，0级时整个世界宽约153像素
+static const double kWorldPixelsAtZoom0 = 40075016.686 / (1 << 18);
+// 墨卡托投影可表示的纬度上限
+static const double kMaxMercatorLat = 85.05112878;
+
+// 纬度换算为墨卡托y，单位与经度相同（度），范围约为[-180, 180]
+static double mercatorY(double latitude)
+{
+    double phi = qDegreesToRadians(qBound(-kMaxMercatorLat, latitude, kMaxMercatorLat));
+    return qRadiansToDegrees(std::log(std::tan(M_PI / 4 + phi / 2)));
+}
+
+ShipClusterIndex::ShipClusterIndex()
+{
+    levels.resize(kClusterMaxZoom - kMinZoom);
+}
+
+bool ShipClusterIndex::isValidPosition(double latitude, double longitude)
+{
+    // 91/181 为AIS规定的"位置不可用"，0/0 是未带位置的报文
+    if (std::isnan(latitude) || std::isnan(longitude)) return false;
+    if (latitude < -90 || latitude > 90 || longitude < -180 || longitude > 180) return false;
+    return !(latitude == 0 && longitude == 0);
+}
+
+double ShipClusterIndex::cellSize(int zoom)
+{
+    return 360.0 * kCellPixels / (kWorldPixelsAtZoom0 * (1 << zoom));
+}
+
+quint64 ShipClusterIndex::cellKey(int zoom, double latitude, double longitude)
+{
+    double size = cellSize(zoom);
+    quint32 ix = static_cast<quint32>(std::floor((longitude + 180) / size));
+    quint32 iy = static_cast<quint32>(std::floor((mercatorY(latitude) + 180) / size));
+    return (quint64(ix) << 32) | iy;
+}
+
+void ShipClusterIndex::addToLevels(const Position& pos, int delta)
+{
+    for (int zoom = kMinZoom; zoom < kClusterMaxZoom; zoom++) {
+        QHash<quint64, Cell>& level = levels[zoom - kMinZoom];
+        quint64 key = cellKey(zoom, pos.latitude, pos.longitude);
+
+        Cell& cell = level[key];
+        cell.count += delta;
+        cell.sumLat += delta * pos.latitude;
+        cell.sumLng += delta * pos.longitude;
+        cell.mmsiXor ^= pos.mmsi;
+        if (cell.count <= 0) {
+            level.remove(key);
+        }
+    }
+}
+
+void ShipClusterIndex::update(const QString& mmsi, double latitude, double longitude)
+{
+    if (!isValidPosition(latitude, longitude)) {
+        remove(mmsi);
+        return;
+    }
+
+    auto it = positions.find(mmsi);
+    if (it != positions.end()) {
+        if (it->latitude == latitude && it->longitude == longitude) return;
+        addToLevels(*it, -1);
+        it->latitude = latitude;
+        it->longitude = longitude;
+    } else {
+        it = positions.insert(mmsi, {latitude, longitude, mmsi.toUInt()});
+    }
+    addToLevels(*it, +1);
+}
+
+void ShipClusterIndex::remove(const QString& mmsi)
+{
+    auto it = positions.find(mmsi);
+    if (it == positions.end()) return;
+
+    addToLevels(*it, -1);
+    positions.erase(it);
+}
+
+void ShipClusterIndex::clear()
+{
+    positions.clear();
+    for (auto& level : levels) {
+        level.clear();
+    }
+}
+
+QVector<ShipCluster> ShipClusterIndex::query(int zoom, const QRectF& bounds) const
+{
+    QVector<ShipCluster> result;
+    zoom = qBound(kMinZoom, zoom, kClusterMaxZoom - 1);
+    const QHash<quint64, Cell>& level = levels[zoom - kMinZoom];
+
+    QRectF view = bounds.normalized().intersected(QRectF(-180, -90, 360, 180));
+    if (view.isEmpty()) return result;
+
+    quint64 minKey = cellKey(zoom, view.top(), view.left());
+    quint64 maxKey = cellKey(zoom, view.bottom(), view.right());
+    quint32 minX = quint32(minKey >> 32), maxX = quint32(maxKey >> 32);
+    quint32 minY = quint32(minKey), maxY = quint32(maxKey);
+
+    auto append = [&result](quint64 key, const Cell& cell) {
+        ShipCluster cluster;
+        cluster.cell = key;
+        cluster.latitude = cell.sumLat / cell.count;
+        cluster.longitude = cell.sumLng / cell.count;
+        cluster.count = cell.count;
+        if (cell.count == 1) {
+            cluster.mmsi = QString::number(cell.mmsiXor);
+        }
+        result.append(cluster);
+    };
+
+    // 视野内网格较少时逐格查找，否则遍历已有网格再按范围过滤
+    quint64 viewCells = quint64(maxX - minX + 1) * (maxY - minY + 1);
+    if (viewCells <= quint64(level.size())) {
+        for (quint32 x = minX; x <= maxX; x++) {
+            for (quint32 y = minY; y <= maxY; y++) {
+                auto it = level.constFind((quint64(x) << 32) | y);
+                if (it != level.constEnd()) append(it.key(), *it);
+            }
+        }
+    } else {
+        for (auto it = level.constBegin(); it != level.constEnd(); ++it) {
+            quint32 x = quint32(it.key() >> 32), y = quint32(it.key());
+            if (x >= minX && x <= maxX && y >= minY && y <= maxY) append(it.key(), *it);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,58 @@
+#ifndef SHIPCLUSTER_H
+#define SHIPCLUSTER_H
+
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QRectF>
+
+struct ShipCluster {
+    double latitude = 0;
+    double longitude = 0;
+    int count = 0;
+    quint64 cell = 0;   // 网格编号，同一缩放级别内唯一，地图据此原地更新聚合点
+    QString mmsi;   // 网格内只有一艘船时为该船MMSI，地图直接显示单船
+};
+
+// 低缩放级别下的船舶聚合：每个缩放级别一张网格，船舶移动时增量更新。
+// 查询只返回视野内各网格的质心和数量，数据量只与视野大小有关，与船舶总数无关。
+// 网格行高按墨卡托投影计算，与百度地图上的显示大小一致。
+class ShipClusterIndex {
+public:
+    // 达到该级别后不再聚合，直接显示单船
+    static constexpr int kClusterMaxZoom = 13;
+    static constexpr int kMinZoom = 3;
+
+    ShipClusterIndex();
+
+    static bool isValidPosition(double latitude, double longitude);
+
+    void update(const QString& mmsi, double latitude, double longitude);
+    void remove(const QString& mmsi);
+    void clear();
+
+    // bounds: x为经度、y为纬度（left=西, top=南, right=东, bottom=北）
+    QVector<ShipCluster> query(int zoom, const QRectF& bounds) const;
+
+private:
+    struct Cell {
+        int count = 0;
+        double sumLat = 0;
+        double sumLng = 0;
+        quint32 mmsiXor = 0;   // 成员MMSI异或，只剩一艘船时即为其MMSI
+    };
+    struct Position {
+        double latitude;
+        double longitude;
+        quint32 mmsi;
+    };
+
+    static double cellSize(int zoom);
+    static quint64 cellKey(int zoom, double latitude, double longitude);
+    void addToLevels(const Position& pos, int delta);
+
+    QVector<QHash<quint64, Cell>> levels;
+    QHash<QString, Position> positions;
+};
+
+#endif // SHIPCLUSTER_H
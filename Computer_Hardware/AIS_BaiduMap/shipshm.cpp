@@ -0,0 +1,298 @@
+#include "shipshm.h"
+#include <cstring>
+#include <unordered_map>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SHIPSHM_POSIX 1
+#endif
+
+static const uint32_t kShipShmMagic = 0x41495353; // "AISS"
+static const uint32_t kShipShmVersion = 3;
+// seqlock读取的最大重试次数
+static const int kMaxReadRetries = 100000;
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "共享内存要求无锁原子操作");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "共享内存要求无锁原子操作");
+
+// 各区按缓存行对齐，减少写者与读者之间的伪共享
+static size_t alignUp(size_t value)
+{
+    return (value + 63) & ~size_t(63);
+}
+
+static size_t slotsOffset()
+{
+    return alignUp(sizeof(ShipShmHeader));
+}
+
+static size_t feedOffset(uint32_t capacity)
+{
+    return alignUp(slotsOffset() + sizeof(ShipShmSlot) * capacity);
+}
+
+static size_t segmentSize(uint32_t capacity, uint32_t feedCapacity)
+{
+    return feedOffset(capacity) + sizeof(ShipShmFeedEntry) * feedCapacity;
+}
+
+struct ShipShmWriter::MmsiIndex {
+    std::unordered_map<uint32_t, uint32_t> slotOf;
+};
+
+ShipShmWriter::~ShipShmWriter()
+{
+    close();
+}
+
+ShipShmReader::~ShipShmReader()
+{
+    close();
+}
+
+#ifdef SHIPSHM_POSIX
+
+// 段已存在时：写者仍在运行则不接管，否则视为上次异常退出的残留段并删除
+static bool removeStaleSegment(const char* name)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return errno == ENOENT;
+
+    struct stat st;
+    pid_t owner = 0;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(ShipShmHeader)) {
+        void* mapped = mmap(nullptr, sizeof(ShipShmHeader), PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped != MAP_FAILED) {
+            const ShipShmHeader* h = static_cast<const ShipShmHeader*>(mapped);
+            if (h->magic.load(std::memory_order_acquire) == kShipShmMagic) {
+                owner = h->ownerPid;
+            }
+            munmap(mapped, sizeof(ShipShmHeader));
+        }
+    }
+    ::close(fd);
+
+    if (owner > 0 && (kill(owner, 0) == 0 || errno == EPERM)) {
+        return false;
+    }
+    return shm_unlink(name) == 0 || errno == ENOENT;
+}
+
+bool ShipShmWriter::open(const char* name, uint32_t capacity, uint32_t feedCapacity)
+{
+    close();
+    if (capacity == 0 || feedCapacity == 0) return false;
+
+    // O_EXCL：不覆盖其他实例正在使用的段
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        if (!removeStaleSegment(name)) return false;
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0) return false;
+
+    size_t size = segmentSize(capacity, feedCapacity);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        shm_unlink(name);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        shm_unlink(name);
+        return false;
+    }
+
+    // 新建的段由ftruncate填零，魔数最后写入
+    char* base = static_cast<char*>(mapped);
+    header = reinterpret_cast<ShipShmHeader*>(base);
+    slots = reinterpret_cast<ShipShmSlot*>(base + slotsOffset());
+    feed = reinterpret_cast<ShipShmFeedEntry*>(base + feedOffset(capacity));
+    mappedSize = size;
+
+    header->version = kShipShmVersion;
+    header->capacity = capacity;
+    header->feedCapacity = feedCapacity;
+    header->ownerPid = static_cast<int32_t>(getpid());
+    header->magic.store(kShipShmMagic, std::memory_order_release);
+
+    index = new MmsiIndex;
+    std::strncpy(segmentName, name, sizeof(segmentName) - 1);
+    return true;
+}
+
+void ShipShmWriter::close()
+{
+    if (!header) return;
+
+    munmap(header, mappedSize);
+    // 已映射的读者不受影响，新读者将无法再打开
+    shm_unlink(segmentName);
+
+    header = nullptr;
+    slots = nullptr;
+    feed = nullptr;
+    mappedSize = 0;
+    delete index;
+    index = nullptr;
+}
+
+bool ShipShmReader::open(const char* name)
+{
+    close();
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShipShmHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+
+    const char* base = static_cast<const char*>(mapped);
+    const ShipShmHeader* h = reinterpret_cast<const ShipShmHeader*>(base);
+    // 与写者的release配对，之后读到的version/capacity一定是初始化后的值
+    if (h->magic.load(std::memory_order_acquire) != kShipShmMagic || h->version != kShipShmVersion
+        || size < segmentSize(h->capacity, h->feedCapacity)) {
+        munmap(mapped, size);
+        return false;
+    }
+
+    header = h;
+    slots = reinterpret_cast<const ShipShmSlot*>(base + slotsOffset());
+    feed = reinterpret_cast<const ShipShmFeedEntry*>(base + feedOffset(h->capacity));
+    mappedSize = size;
+    feedTail = header->feedHead.load(std::memory_order_acquire);
+    return true;
+}
+
+void ShipShmReader::close()
+{
+    if (!header) return;
+
+    munmap(const_cast<ShipShmHeader*>(header), mappedSize);
+    header = nullptr;
+    slots = nullptr;
+    feed = nullptr;
+    mappedSize = 0;
+}
+
+#else // 非POSIX平台：不发布共享内存
+
+bool ShipShmWriter::open(const char*, uint32_t, uint32_t)
+{
+    return false;
+}
+
+void ShipShmWriter::close()
+{
+}
+
+bool ShipShmReader::open(const char*)
+{
+    return false;
+}
+
+void ShipShmReader::close()
+{
+}
+
+#endif
+
+int ShipShmWriter::publish(const ShipShmRecord& record)
+{
+    if (!header) return -1;
+
+    uint32_t slot;
+    bool isNew = false;
+    auto it = index->slotOf.find(record.mmsi);
+    if (it != index->slotOf.end()) {
+        slot = it->second;
+    } else {
+        uint32_t count = header->shipCount.load(std::memory_order_relaxed);
+        if (count >= header->capacity) return -1;
+        slot = count;
+        index->slotOf.emplace(record.mmsi, slot);
+        isNew = true;
+    }
+
+    // seqlock：奇数表示正在写
+    ShipShmSlot& target = slots[slot];
+    uint32_t seq = target.seq.load(std::memory_order_relaxed);
+    target.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&target.record, &record, sizeof(ShipShmRecord));
+    target.seq.store(seq + 2, std::memory_order_release);
+
+    if (isNew) {
+        header->shipCount.store(slot + 1, std::memory_order_release);
+    }
+
+    // 先写条目再推进head，读者看到head时条目一定可见
+    uint64_t head = header->feedHead.load(std::memory_order_relaxed);
+    uint64_t entry = (uint64_t(uint32_t(head)) << 32) | slot;
+    feed[head % header->feedCapacity].store(entry, std::memory_order_relaxed);
+    header->feedHead.store(head + 1, std::memory_order_release);
+
+    return static_cast<int>(slot);
+}
+
+uint32_t ShipShmReader::shipCount() const
+{
+    return header ? header->shipCount.load(std::memory_order_acquire) : 0;
+}
+
+bool ShipShmReader::read(uint32_t slot, ShipShmRecord& out) const
+{
+    if (slot >= shipCount()) return false;
+
+    const ShipShmSlot& source = slots[slot];
+    for (int attempt = 0; attempt < kMaxReadRetries; attempt++) {
+        uint32_t before = source.seq.load(std::memory_order_acquire);
+        if (before & 1) continue;
+
+        std::memcpy(&out, &source.record, sizeof(ShipShmRecord));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (source.seq.load(std::memory_order_relaxed) == before) return true;
+    }
+    return false;
+}
+
+bool ShipShmReader::pollChanges(std::vector<uint32_t>& changedSlots)
+{
+    if (!header) return false;
+
+    uint64_t head = header->feedHead.load(std::memory_order_acquire);
+    uint32_t feedCapacity = header->feedCapacity;
+    if (head - feedTail > feedCapacity) {
+        feedTail = head;
+        return false;
+    }
+
+    for (uint64_t i = feedTail; i < head; i++) {
+        uint64_t entry = feed[i % feedCapacity].load(std::memory_order_relaxed);
+        // 序号不符说明条目已被写者的下一圈覆盖
+        if (uint32_t(entry >> 32) != uint32_t(i)) {
+            feedTail = header->feedHead.load(std::memory_order_acquire);
+            return false;
+        }
+        changedSlots.push_back(uint32_t(entry));
+    }
+
+    feedTail = head;
+    return true;
+}
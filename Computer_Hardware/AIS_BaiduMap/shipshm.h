@@ -0,0 +1,116 @@
+#ifndef SHIPSHM_H
+#define SHIPSHM_H
+
+// 船舶状态共享内存发布。
+// 本文件不依赖Qt，其他本地工具（日志、告警、副显示器）可直接包含使用。
+//
+// 布局：Header | Slot[capacity] | FeedEntry[feedCapacity]
+//  - 每个Slot保存一艘船的最新状态，用序号锁（seqlock）保护：
+//    写者先把seq加到奇数、写数据、再加到偶数；读者读到相同的偶数seq才算一致。
+//  - Feed是单写者环形变更队列，记录被更新的Slot下标，读者按自己的进度轮询。
+//    读者落后超过一整圈时会收到溢出通知，需要全量重读。
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+static const char kShipShmDefaultName[] = "/ais_ship_state";
+
+// ShipShmRecord::flags
+static const uint32_t kShipShmRestored = 1;   // 从快照恢复，重启后尚未收到该船的新报文
+
+struct ShipShmRecord {
+    uint32_t mmsi = 0;
+    int32_t type = -1;
+    double latitude = 0;
+    double longitude = 0;
+    double sog = 0;
+    double cog = 0;
+    int32_t heading = -1;
+    int32_t shipType = 0;
+    int64_t timestampMs = 0;   // 自1970年起的毫秒数
+    char name[24] = {};
+    char callsign[8] = {};
+    char destination[24] = {};
+    uint32_t flags = 0;
+};
+
+struct ShipShmSlot {
+    std::atomic<uint32_t> seq;
+    uint32_t reserved;
+    ShipShmRecord record;
+};
+
+struct ShipShmHeader {
+    std::atomic<uint32_t> magic;      // 写者初始化完成后最后写入（release）
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t feedCapacity;
+    std::atomic<uint32_t> shipCount;
+    int32_t ownerPid;                 // 写者进程号，用于判断残留段是否可接管
+    std::atomic<uint64_t> feedHead;   // 已写入的变更总数
+};
+
+// 低32位为Slot下标，高32位为写入时的feed序号，用于检测被覆盖
+using ShipShmFeedEntry = std::atomic<uint64_t>;
+
+class ShipShmWriter {
+public:
+    ShipShmWriter() = default;
+    ~ShipShmWriter();
+    ShipShmWriter(const ShipShmWriter&) = delete;
+    ShipShmWriter& operator=(const ShipShmWriter&) = delete;
+
+    // 段已存在且其写者仍在运行时返回false（不会清空别人的段）；
+    // 写者已退出的残留段会被删除后重新创建
+    bool open(const char* name = kShipShmDefaultName,
+              uint32_t capacity = 65536, uint32_t feedCapacity = 16384);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    // 按MMSI更新或新增一艘船，返回Slot下标；表满时返回-1
+    int publish(const ShipShmRecord& record);
+
+private:
+    struct MmsiIndex;
+
+    ShipShmHeader* header = nullptr;
+    ShipShmSlot* slots = nullptr;
+    ShipShmFeedEntry* feed = nullptr;
+    size_t mappedSize = 0;
+    MmsiIndex* index = nullptr;
+    char segmentName[64] = {};
+};
+
+class ShipShmReader {
+public:
+    ShipShmReader() = default;
+    ~ShipShmReader();
+    ShipShmReader(const ShipShmReader&) = delete;
+    ShipShmReader& operator=(const ShipShmReader&) = delete;
+
+    // 从当前时刻开始跟踪变更
+    bool open(const char* name = kShipShmDefaultName);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    uint32_t shipCount() const;
+
+    // 读取一个Slot的一致副本；写者正在写时有限次重试，
+    // 仍读不到一致数据（例如写者在写入中途退出）时返回false
+    bool read(uint32_t slot, ShipShmRecord& out) const;
+
+    // 取出自上次调用以来变更过的Slot下标（可能重复）。
+    // 返回false表示读者落后太多、变更已被覆盖，调用方应全量重读。
+    bool pollChanges(std::vector<uint32_t>& changedSlots);
+
+private:
+    const ShipShmHeader* header = nullptr;
+    const ShipShmSlot* slots = nullptr;
+    const ShipShmFeedEntry* feed = nullptr;
+    size_t mappedSize = 0;
+    uint64_t feedTail = 0;
+};
+
+#endif // SHIPSHM_H
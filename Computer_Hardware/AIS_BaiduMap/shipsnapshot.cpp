@@ -0,0 +1,130 @@
+#include "shipsnapshot.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+static const QDataStream::Version kStreamVersion = QDataStream::Qt_6_0;
+
+static void writeShip(QDataStream& out, const AisMessage& msg)
+{
+    out << qint32(msg.type) << msg.mmsi
+        << msg.latitude << msg.longitude << msg.sog << msg.cog << qint32(msg.heading)
+        << msg.name << msg.timestamp << msg.rawPayload
+        << msg.imo << msg.callsign << msg.shipType
+        << qint32(msg.dimensionToBow) << qint32(msg.dimensionToStern)
+        << qint32(msg.dimensionToPort) << qint32(msg.dimensionToStarboard)
+        << msg.destination << qint32(msg.aidType)
+        << msg.isOffPosition << msg.isVirtual << msg.aidName
+        << qint32(msg.positionAccuracy) << qint32(msg.fixType);
+}
+
+static void readShip(QDataStream& in, AisMessage& msg)
+{
+    qint32 type, heading, bow, stern, port, starboard, aidType, accuracy, fixType;
+    in >> type >> msg.mmsi
+       >> msg.latitude >> msg.longitude >> msg.sog >> msg.cog >> heading
+       >> msg.name >> msg.timestamp >> msg.rawPayload
+       >> msg.imo >> msg.callsign >> msg.shipType
+       >> bow >> stern >> port >> starboard
+       >> msg.destination >> aidType
+       >> msg.isOffPosition >> msg.isVirtual >> msg.aidName
+       >> accuracy >> fixType;
+
+    msg.type = type;
+    msg.heading = heading;
+    msg.dimensionToBow = bow;
+    msg.dimensionToStern = stern;
+    msg.dimensionToPort = port;
+    msg.dimensionToStarboard = starboard;
+    msg.aidType = aidType;
+    msg.positionAccuracy = accuracy;
+    msg.fixType = fixType;
+}
+
+QString ShipSnapshot::defaultPath()
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    return dir + "/ships.snapshot";
+}
+
+bool ShipSnapshot::save(const std::vector<AisMessage>& ships, const QString& path)
+{
+    QByteArray body;
+    {
+        QDataStream out(&body, QIODevice::WriteOnly);
+        out.setVersion(kStreamVersion);
+        for (const auto& msg : ships) {
+            writeShip(out, msg);
+        }
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "无法写入船舶快照:" << path;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(kStreamVersion);
+    out << kMagic << kVersion << quint32(ships.size())
+        << quint32(body.size()) << quint16(qChecksum(body));
+    out.writeRawData(body.constData(), body.size());
+
+    // commit() 成功后才替换旧快照
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool ShipSnapshot::load(const QString& path, std::vector<AisMessage>& ships)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 size = file.size();
+    uchar* mapped = file.map(0, size);
+    if (!mapped) {
+        qWarning() << "船舶快照映射失败:" << path;
+        return false;
+    }
+
+    // 直接在映射内存上解析，不额外拷贝文件内容
+    QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), size);
+    QDataStream in(raw);
+    in.setVersion(kStreamVersion);
+
+    quint32 magic, version, count, bodySize;
+    quint16 checksum;
+    in >> magic >> version >> count >> bodySize >> checksum;
+
+    const qint64 headerSize = in.device()->pos();
+    if (in.status() != QDataStream::Ok || magic != kMagic || version != kVersion
+        || headerSize + bodySize != size
+        || qChecksum(QByteArrayView(raw).sliced(headerSize, bodySize)) != checksum) {
+        qWarning() << "船舶快照无效，已忽略:" << path;
+        file.unmap(mapped);
+        return false;
+    }
+
+    // 头部的count不在校验范围内，不能据此预分配；逐条读取直到数据用完
+    std::vector<AisMessage> loaded;
+    while (loaded.size() < count && !in.atEnd() && in.status() == QDataStream::Ok) {
+        AisMessage msg;
+        readShip(in, msg);
+        loaded.push_back(std::move(msg));
+    }
+
+    file.unmap(mapped);
+
+    if (in.status() != QDataStream::Ok || loaded.size() != count || !in.atEnd()) {
+        qWarning() << "船舶快照内容损坏:" << path;
+        return false;
+    }
+
+    ships.swap(loaded);
+    return true;
+}
@@ -0,0 +1,26 @@
+#ifndef SHIPSNAPSHOT_H
+#define SHIPSNAPSHOT_H
+
+#include <QString>
+#include <vector>
+#include "ais_anal.h"
+
+// 船舶状态快照：把完整船舶表写成二进制文件，重启后直接映射加载，
+// 不必等待每隔几分钟才发送一次的5号静态报文重新填满。
+class ShipSnapshot {
+public:
+    static QString defaultPath();
+
+    // 原子写入（先写临时文件再替换），中途崩溃不会留下半个快照。
+    // 可在后台线程调用，ships 应为调用方持有的副本。
+    static bool save(const std::vector<AisMessage>& ships, const QString& path);
+
+    // 通过内存映射读取快照；文件不存在、损坏或版本不符时返回false且不修改ships
+    static bool load(const QString& path, std::vector<AisMessage>& ships);
+
+private:
+    static constexpr quint32 kMagic = 0x41495353; // "AISS"
+    static constexpr quint32 kVersion = 1;
+};
+
+#endif // SHIPSNAPSHOT_H
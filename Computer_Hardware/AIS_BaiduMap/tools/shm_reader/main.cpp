@@ -0,0 +1,70 @@
+// 共享内存读者示例：映射 AIS_BaiduMap 发布的船舶状态表并打印变更。
+// 用法：shm_reader [--once] [段名]
+//   --once  只打印当前全部船舶后退出
+
+#include "../../shipshm.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <unordered_set>
+
+static void printRecord(uint32_t slot, const ShipShmRecord& r)
+{
+    std::printf("[%5u] MMSI: %09u | 类型: %2d | 位置: %.6f, %.6f | 航速: %.1f 节 | 航向: %.1f° | %s%s\n",
+                slot, r.mmsi, r.type, r.latitude, r.longitude, r.sog, r.cog,
+                r.name[0] ? r.name : "-", (r.flags & kShipShmRestored) ? " | 快照恢复" : "");
+}
+
+static void dumpAll(const ShipShmReader& reader)
+{
+    ShipShmRecord record;
+    uint32_t count = reader.shipCount();
+    for (uint32_t slot = 0; slot < count; slot++) {
+        if (reader.read(slot, record)) {
+            printRecord(slot, record);
+        }
+    }
+    std::printf("共 %u 艘船\n", count);
+}
+
+int main(int argc, char* argv[])
+{
+    bool once = false;
+    const char* name = kShipShmDefaultName;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--once") == 0) once = true;
+        else name = argv[i];
+    }
+
+    ShipShmReader reader;
+    if (!reader.open(name)) {
+        std::fprintf(stderr, "无法打开共享内存段 %s（发布程序是否在运行？）\n", name);
+        return 1;
+    }
+
+    dumpAll(reader);
+    if (once) return 0;
+
+    std::vector<uint32_t> changed;
+    std::unordered_set<uint32_t> seen;
+    ShipShmRecord record;
+    for (;;) {
+        changed.clear();
+        if (!reader.pollChanges(changed)) {
+            std::printf("变更队列溢出，重新读取全部船舶\n");
+            dumpAll(reader);
+            continue;
+        }
+
+        // 同一轮内重复更新的船只打印最新状态一次
+        seen.clear();
+        for (uint32_t slot : changed) {
+            if (seen.insert(slot).second && reader.read(slot, record)) {
+                printRecord(slot, record);
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}
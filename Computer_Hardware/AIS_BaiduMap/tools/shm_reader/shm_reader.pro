@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = shm_reader
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+SOURCES += \
+    main.cpp \
+    ../../shipshm.cpp
+
+HEADERS += \
+    ../../shipshm.h
+
+unix:!macx: LIBS += -lrt